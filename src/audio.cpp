@@ -3,18 +3,28 @@
 #include <iostream>
 #include <cmath>
 
-bool Audio::Initialize()
+bool Audio::Initialize(bool queued)
 {
     SDL_AudioSpec desired{};
     SDL_AudioSpec obtained{};               // where SDL put the real format
     desired.freq = kFrequency;
     desired.format = AUDIO_F32;
     desired.channels = 1;
-    desired.samples = 2048;
-    desired.callback = AudioCallback;
-    desired.userdata = this;                // this - pointer to the current Audio object
+    if (queued)
+    { // no callback: QueueFrame() pushes samples, so the buffer can be small (lower latency)
+        desired.samples = 256;
+        desired.callback = nullptr;
+    }
+    else
+    {
+        desired.samples = 2048;
+        desired.callback = AudioCallback;
+        desired.userdata = this;            // this - pointer to the current Audio object
+    }
 
-    device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_ANY_CHANGE);
+    // queued samples are written as mono float by us, so only let SDL change the rate and buffer size there
+    int allowed = queued ? (SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE) : SDL_AUDIO_ALLOW_ANY_CHANGE;
+    device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, allowed);
 
     if (!device)
     { // handle open-failure first
@@ -22,6 +32,7 @@ bool Audio::Initialize()
         return false;
     }
 
+    sample_rate = obtained.freq;
     wave_increment = static_cast<float>(kTone * 2.0 * M_PI / obtained.freq);        // “How far should I advance the phase for one sample so that my pitch comes out right?” so that, after the device has played exactly sample_rate samples, the phase has looped 440 times. Calculated as 2π × f / Fs.
 
     SDL_PauseAudioDevice(device, 0); // Start the audio thread
@@ -39,30 +50,82 @@ void Audio::StopBeep()
     beep_on = false;
 }
 
-void Audio::AudioCallback(void *userdata, Uint8 *stream, int len)
+void Audio::Generate(float *out, int samples)
 {
-    Audio *audio = static_cast<Audio *>(userdata);              // Recovers the audio object that owns this callback
-    float *fstream = reinterpret_cast<float *>(stream);
-    int samples = len / sizeof(float);                          // Number of samples that SDL wants this time
-
     for (int i = 0; i < samples; ++i)
     {
-        if (audio->beep_on)
+        if (beep_on)
         { // for each sample you look at wave position, output +0.25 or -0.25 to make a square-wave (that's amplitude)
-            fstream[i] = (audio->wave_position < M_PI) ? kAmplitude : -kAmplitude;
+            out[i] = (wave_position < M_PI) ? kAmplitude : -kAmplitude;
         }
         else
         {
-            fstream[i] = 0.0f;
+            out[i] = 0.0f;
         }
-        audio->wave_position += audio->wave_increment;          // Advance phase by one sample
-        if (audio->wave_position >= 2.0f * M_PI)
+        wave_position += wave_increment;                        // Advance phase by one sample
+        if (wave_position >= 2.0f * M_PI)
         { // Wrap back to 0 once you hit 2pie so the float never explodes. This keeps the angle in [0, 2pie]
-            audio->wave_position -= 2.0f * M_PI;
+            wave_position -= 2.0f * M_PI;
         }
     }
 }
 
+void Audio::AudioCallback(void *userdata, Uint8 *stream, int len)
+{
+    Audio *audio = static_cast<Audio *>(userdata);              // Recovers the audio object that owns this callback
+    float *fstream = reinterpret_cast<float *>(stream);
+    int samples = len / sizeof(float);                          // Number of samples that SDL wants this time
+
+    audio->Generate(fstream, samples);
+}
+
+void Audio::QueueFrame(int targetMs)
+{
+    if (!device)
+    {
+        return;
+    }
+
+    // 1) Measure the queue first, in samples, before the caller blocks: at this point it can be above or below target
+    double target = targetMs * sample_rate / 1000.0;
+    Uint32 queued = QueuedSamples();
+    if (queued == 0)
+    { // start-up or underrun: refill to the target with silence so the controller starts from the right level
+        frame_samples.assign(static_cast<std::size_t>(target), 0.0f);
+        SDL_QueueAudio(device, frame_samples.data(), frame_samples.size() * sizeof(float));
+        queued_total += frame_samples.size();
+        queued = static_cast<Uint32>(frame_samples.size());
+    }
+
+    // 2) Dynamic rate control: queue above target -> slightly shorter frame, below -> slightly longer.
+    //    The caller waits for one nominal frame of playback per frame, so the difference is what moves the queue level.
+    double error = (target - queued) / target;      // -1 .. 1 around the target
+    error = std::fmax(-1.0, std::fmin(1.0, error));
+    frame_remainder += FrameSamples() * (1.0 + kMaxRateDelta * error);
+
+    int samples = static_cast<int>(frame_remainder);
+    frame_remainder -= samples;
+
+    frame_samples.resize(samples);
+    Generate(frame_samples.data(), samples);
+    SDL_QueueAudio(device, frame_samples.data(), samples * sizeof(float));
+    queued_total += samples;
+}
+
+Uint32 Audio::QueuedSamples() const
+{
+    if (!device)
+    {
+        return 0;
+    }
+    return SDL_GetQueuedAudioSize(device) / sizeof(float);
+}
+
+Uint64 Audio::ConsumedSamples() const
+{
+    return queued_total - QueuedSamples();
+}
+
 Audio::~Audio()
 {
     SDL_PauseAudioDevice(device, 1);            // Stop audio
@@ -3,28 +3,43 @@
 
 #include <SDL.h>
 #include <atomic>
+#include <vector>
 
 class Audio {
 public:
     ~Audio();                               // Destructor (cleanup when Audio object is destroyed)
 
-    bool Initialize();                      // Sets up SDL audio - returns true if successful
+    bool Initialize(bool queued = false);   // Sets up SDL audio - returns true if successful. queued = we push samples (QueueFrame) instead of SDL pulling them
     void StartBeep();                       // Turns on beep sound
     void StopBeep();                        // Turns off beep sound
 
+    // Queued mode only: the device's playback becomes the emulator's clock
+    void QueueFrame(int targetMs);          // Queue one 60 Hz frame of samples, slightly more/fewer to steer the queue toward targetMs
+    Uint32 QueuedSamples() const;           // Audio waiting to be played
+    Uint64 ConsumedSamples() const;         // Audio the device has taken so far (the master clock)
+    double FrameSamples() const { return sample_rate / 60.0; }  // Nominal samples per 60 Hz frame
+
 private:
     // Audio Settings (constants):
     static constexpr double kFrequency = 44100;     // Sample rate (44.1 kHz) - How many audio samples per second SDL needs (standard CD quality)
     static constexpr double kTone = 440;            // Chip8 Beep frequency (440 Hz = A note)
     static constexpr float kAmplitude = 0.25f;      // Volume (0.25 = 25% volume)
+    static constexpr double kMaxRateDelta = 0.005;  // Queued mode: frame length may stretch/shrink by up to 0.5% (inaudible on a square wave)
 
     SDL_AudioDeviceID device = 0;                   // SDL's audio device handle - Needed to pause/unpause and close audio.
+    int sample_rate = 0;                            // Rate the device actually opened with
     std::atomic<bool> beep_on{false};               // Whether the beep is currently playinh (atomic = thread-safe. safe to change from the main thread while SDL’s audio thread reads it)
 
     // Wave generation:
     float wave_position = 0.0f;                     // Current position in the sound wave cycle in radians 0 to 2π (0 to 360 degrees)
     float wave_increment = 0.0f;                    // How much to advance wave position for each audio sample, based on the obtained frequency
 
+    // Queued mode:
+    double frame_remainder = 0.0;                   // Fractional samples carried over so frames average out to exactly rate/60
+    Uint64 queued_total = 0;                        // Every sample ever queued (consumed = this - still queued)
+    std::vector<float> frame_samples;               // Scratch buffer for one frame
+
+    void Generate(float* out, int samples);         // Fill out[] with the beep (or silence), advancing the wave
     static void AudioCallback(void* userdata, Uint8* stream, int len);  // SDL calls this to get audio samples
 };
 
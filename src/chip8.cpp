@@ -1,11 +1,11 @@
-#include <cstdlib>   // for std::srand(), std::rand()
-#include <ctime>     // for std::time()
+#include <random>    // for std::random_device
 #include <cstring>   // for std::memset()
 #include <fstream>   // for std::ifstream
 #include <iostream>  // for std::cerr
 #include "chip8.h"
 #include <SDL.h>
 #include <atomic>
+#include <utility>   // for std::move()
 
 static constexpr int SCREEN_W = 64;
 static constexpr int SCREEN_H = 32;
@@ -31,9 +31,27 @@ static const uint8_t fontset[80] = {
 };
 
 
+// Zeroed memory with the fontset at 0x50, built once and shared by every instance
+static std::shared_ptr<const PagedMemory::Image> fontImage() {
+    static const auto image = [] {
+        auto img = std::make_shared<PagedMemory::Image>();
+        img->fill(0);
+        for (int i = 0; i < 80; ++i)
+            (*img)[0x050 + i] = fontset[i];
+        return std::shared_ptr<const PagedMemory::Image>(std::move(img));
+    }();
+    return image;
+}
+
+
 // Constructor
 Chip8::Chip8() { 
-    std::srand(static_cast<unsigned>(std::time(nullptr)));  // seed RNG so CXNN yields varied random values
+    setSeed(std::random_device{}());    // seed RNG so CXNN yields varied random values (--seed overrides it)
+}
+
+void Chip8::setSeed(uint32_t value) {
+    seedValue = value;
+    rng = value ? value : 0x2545F491;   // xorshift state must be non-zero
 }
 
 void Chip8::init() {
@@ -41,6 +59,8 @@ void Chip8::init() {
     opcode = 0;         // Reset current opcode
     I = 0;              // Reset index register
     sp = 0;             // Reset stack pointer
+    trap = Trap::None;  // Clear any earlier fault
+    setSeed(seedValue); // Restart the random sequence
 
     // Clear display
     gfx.fill(0);
@@ -54,12 +74,8 @@ void Chip8::init() {
     // Clear keys state
     keypad.fill(0);
 
-    // Clear memory
-    memory.fill(0);
-
-    // Load fontset at memory location 0x50
-    for (int i = 0; i < 80; ++i) 
-        memory[0x050 + i] = fontset[i];
+    // Clear memory and load fontset at 0x50 (one shared image for every instance)
+    memory.attach(fontImage());
     
     // Reset timers
     delay_timer = 0;
@@ -71,41 +87,57 @@ void Chip8::init() {
 }
 
 bool Chip8::loadApplication(const std::string& filepath) {
-    init(); // Clear everything, reset state, load fontset, etc.
-    
+    auto image = loadImage(filepath);
+    if (!image) {
+        return false;
+    }
+    return loadApplication(std::move(image));
+}
+
+bool Chip8::loadApplication(std::shared_ptr<const PagedMemory::Image> image) {
+    if (!image) {
+        return false;
+    }
+    init(); // Clear everything, reset state, etc.
+    memory.attach(std::move(image));
+    return true;
+}
+
+std::shared_ptr<const PagedMemory::Image> Chip8::loadImage(const std::string& filepath) {
     // 1) Open file path in binary mode + go to end to get size
     std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
-        return false;
+        return nullptr;
     }
 
     // 2) Measure, validate size of ROM
     std::streamsize romSize = file.tellg(); // Get size of ROM
 
     // Maximum space from 0x200 to 0xFFF (512 to 4095 bytes)
-    const std::size_t MAX_ROM_SIZE = memory.size() - 0x200; // 3584 bytes
+    const std::streamsize MAX_ROM_SIZE = PagedMemory::kSize - 0x200; // 3584 bytes
     // Check if ROM size is valid
     if (romSize <= 0 || romSize > MAX_ROM_SIZE) {
-        return false;
+        return nullptr;
     }
 
-    // 3) Go back to start and read ROM into memory starting at 0x200
+    // 3) Start from the fontset image, then read ROM into it starting at 0x200
+    auto image = std::make_shared<PagedMemory::Image>(*fontImage());
     file.seekg(0, std::ios::beg);
-    auto dst = memory.data() + 0x200;             // uint8_t*
+    auto dst = image->data() + 0x200;             // uint8_t*
     auto ptr = reinterpret_cast<char*>(dst);      // tell read() "here's a char*"
     file.read(ptr, romSize);                     
     if (file.fail()) {
-        return false;
+        return nullptr;
     }
 
-    return true;
+    return image;
 }
 
 void Chip8::updateTimers() {
     // Each call = 1/60 s "tick"
 
     // 0) if we ended last tick still beeping but timer now 0, turn it off 
-    if (isBeeping && sound_timer == 0) {
+    if (isBeeping && sound_timer == 0 && !speculative) {
         stopBeep();
         isBeeping = false;
     }
@@ -117,8 +149,8 @@ void Chip8::updateTimers() {
 
     // 2) if sound_timer > 0 start the beep (once) if it hasn't started already, then decrement the timer
     if (sound_timer > 0) {
-        // first tick of a new beep
-        if (!isBeeping) {
+        // first tick of a new beep (speculative frames leave the beeper alone)
+        if (!isBeeping && !speculative) {
             startBeep();
             isBeeping = true;
         }
@@ -127,6 +159,46 @@ void Chip8::updateTimers() {
 
 }
 
+void Chip8::saveState(State& out) const {
+    out.pc = pc;
+    out.opcode = opcode;
+    out.I = I;
+    out.sp = sp;
+    out.V = V;
+    out.stack = stack;
+    out.memory = memory;
+    out.delay_timer = delay_timer;
+    out.sound_timer = sound_timer;
+    out.rng = rng;
+    out.gfx = gfx;
+    out.drawFlag = drawFlag;
+    out.trap = trap;
+}
+
+void Chip8::loadState(const State& in) {
+    pc = in.pc;
+    opcode = in.opcode;
+    I = in.I;
+    sp = in.sp;
+    V = in.V;
+    stack = in.stack;
+    memory = in.memory;
+    delay_timer = in.delay_timer;
+    sound_timer = in.sound_timer;
+    rng = in.rng;
+    gfx = in.gfx;
+    drawFlag = in.drawFlag;
+    trap = in.trap;
+}
+
+uint8_t Chip8::nextRandom() {
+    // xorshift32: fast, and unlike std::rand() its state can be saved and restored with the machine
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng & 0xFF;
+}
+
 void Chip8::startBeep() {
     audio.StartBeep();
 }
@@ -134,9 +206,23 @@ void Chip8::stopBeep()  {
     audio.StopBeep();
 }
 
+const char* Chip8::trapReason() const {
+    switch (trap) {
+        case Trap::StackOverflow:  return "stack overflow (more than 16 nested calls)";
+        case Trap::StackUnderflow: return "stack underflow (return with empty stack)";
+        default:                   return "none";
+    }
+}
+
 void Chip8::emulateCycle() {
+    // 0) A trapped machine stays stopped (memory accesses can't go out of range, they're masked in PagedMemory)
+    if (trap != Trap::None) {
+        return;
+    }
+
     // 1) Fetch next opcode (big-indian two bytes)
-    opcode = (memory[pc] << 8) | memory[pc + 1];
+    uint16_t opcodePc = pc;                 // kept for the trace record
+    opcode = (memory.read(pc) << 8) | memory.read(pc + 1);
     pc += 2;
     uint16_t nnn = opcode & 0x0FFF;         // address
     uint8_t regX = (opcode & 0x0F00) >> 8;  // Extract V-reg X
@@ -153,6 +239,11 @@ void Chip8::emulateCycle() {
                     break;
 
                 case 0x00EE: // RET: Return from subroutine
+                    if (sp == 0) {
+                        trap = Trap::StackUnderflow;
+                        pc -= 2;    // leave pc on the faulting instruction
+                        break;
+                    }
                     --sp;
                     pc = stack[sp];
                     break;
@@ -167,6 +258,11 @@ void Chip8::emulateCycle() {
             break;
 
         case 0x2000: // 2NNN: CALL addr, push current pc on top of stack then set pc to nnn
+            if (sp == stack.size()) {
+                trap = Trap::StackOverflow;
+                pc -= 2;    // leave pc on the faulting instruction
+                break;
+            }
             stack[sp] = pc; // push the address you just moved to (i.e. return‑address)
             sp++;
             pc = nnn; // jump into the subroutine
@@ -265,7 +361,7 @@ void Chip8::emulateCycle() {
             break;
                
         case 0xC000: // CXKK: Sets VX to the result of a bitwise and operation on a random number (0 to 255) and KK.
-            V[regX] = (std::rand() & 0xFF) & val;
+            V[regX] = nextRandom() & val;
             break;
         
         case 0xD000: { // DXYN: draw sprite at (Vx,Vy), height=N, XOR, wrap, VF=collision
@@ -282,7 +378,7 @@ void Chip8::emulateCycle() {
 
             for (int row = 0; row < height; row++) 
             {
-                sprite = memory[I + row];
+                sprite = memory.read(I + row);
                 for (int col = 0; col < 8; col++) 
                 {
                     if ((sprite & (0x80 >> col)) != 0) // checks the pixel value of sprite. if pixel is 1 check for collision and XOR with current pixel on display
@@ -306,13 +402,13 @@ void Chip8::emulateCycle() {
         case 0xE000: // Two instructions possible
             switch(val) {
                 case 0x9E: // EX9E: Skips the next instruction if key stored in Vx is pressed.
-                    if (keypad[V[regX]] != 0) {
+                    if (keypad[V[regX] & 0xF] != 0) {   // mask: Vx can hold any byte, only 16 keys exist
                         pc += 2;
                     }
                     break;
                 
                 case 0xA1: // EXA1: Skips the next instruction if key stored in Vx is NOT pressed.
-                    if (keypad[V[regX]] == 0) {
+                    if (keypad[V[regX] & 0xF] == 0) {
                         pc += 2;
                     }
                     break;
@@ -361,20 +457,20 @@ void Chip8::emulateCycle() {
                     break;
                 
                 case 0x33: // FX33: Stores the binary-coded decimal representation of Vx, with the hundreds digit in memory location I, the tens digit in I+1, and the ones digit in I+2.
-                    memory[I] = V[regX] / 100; // Integer division (/) truncates towards zero when both operands are integers
-                    memory[I + 1] = (V[regX] / 10) % 10;
-                    memory[I + 2] =  V[regX] % 10;
+                    memory.write(I, V[regX] / 100); // Integer division (/) truncates towards zero when both operands are integers
+                    memory.write(I + 1, (V[regX] / 10) % 10);
+                    memory.write(I + 2, V[regX] % 10);
                     break;
                 
                 case 0x55: // FX55: Stores V0 to VX (inclusive) in memory starting at address stored in I.
                     for (int i = 0; i <= regX; ++i) {
-                        memory[I + i] = V[i];
+                        memory.write(I + i, V[i]);
                     }
                     break;
                 
                 case 0x65: //FX65: Read V0 to Vx (inclusive) from memory starting at address stored in I.
                     for (int i = 0; i <= regX; ++i) {
-                        V[i] = memory[I + i];
+                        V[i] = memory.read(I + i);
                     }
                     break;
                 
@@ -393,4 +489,9 @@ void Chip8::emulateCycle() {
           << "\n";
         break;
     }
-}
\ No newline at end of file
+
+    // Record the resulting state if tracing is on
+    if (tracer && !speculative) {
+        tracer->record({opcodePc, opcode, I, delay_timer, sound_timer, V});
+    }
+}
@@ -1,16 +1,57 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <memory>
+#include <string>
 #include "audio.h"
+#include "pagedmemory.h"
+#include "trace.h"
 
 class Chip8 {
     public:
+        // Why the machine stopped (a ROM bug the CPU can't continue from)
+        enum class Trap : uint8_t {
+            None,
+            StackOverflow,      // 2NNN with all 16 stack slots in use
+            StackUnderflow,     // 00EE with an empty stack
+        };
+
+        // Everything that determines what the machine does next (no audio device, no keypad).
+        // Cheap to copy: memory pages are shared copy-on-write, so save/load is ~2.5 KB of memcpy.
+        struct State {
+            uint16_t pc, opcode, I;
+            uint8_t sp;
+            std::array<uint8_t, 16> V;
+            std::array<uint16_t, 16> stack;
+            PagedMemory memory;
+            uint8_t delay_timer, sound_timer;
+            uint32_t rng;
+            std::array<uint8_t, 64 * 32> gfx;
+            bool drawFlag;
+            Trap trap;
+        };
+
         Chip8();                                                // Constructor
         void init();                                            // Reset CPU, load fontset
         bool loadApplication(const std::string& filepath);      // load ROM at 0x200
-        void emulateCycle();                                    // fetch-decode-execute one opcode
+        bool loadApplication(std::shared_ptr<const PagedMemory::Image> image);  // run a shared ROM image (see loadImage)
+        static std::shared_ptr<const PagedMemory::Image> loadImage(const std::string& filepath);  // fontset + ROM, shareable between instances
+        void emulateCycle();                                    // fetch-decode-execute one opcode (does nothing once trapped)
+        bool trapped() const { return trap != Trap::None; }     // stopped on a bad stack operation, see trapReason()
+        const char* trapReason() const;
         void updateTimers();                                    // decrement delay & sound @60 Hz
-        bool initAudio() { return audio.Initialize(); }         // Initialize audio system
+        bool initAudio(bool audioClock = false) { return audio.Initialize(audioClock); }   // Initialize audio system (audioClock: frontend paces on queueAudioFrame)
+        void queueAudioFrame(int targetMs) { audio.QueueFrame(targetMs); }  // audio-clock mode: one 60 Hz frame of sound
+        uint32_t queuedAudioSamples() const { return audio.QueuedSamples(); }     // audio-clock mode: sound not yet played
+        uint64_t consumedAudioSamples() const { return audio.ConsumedSamples(); } // audio-clock mode: the master clock
+        double audioFrameSamples() const { return audio.FrameSamples(); }         // audio-clock mode: samples per 60 Hz frame
+        void setTracer(TraceRecorder* recorder) { tracer = recorder; }  // record every cycle (nullptr = off)
+        void setSeed(uint32_t value);                           // CXNN random sequence; same seed + same input = same run (applies from the next init())
+        uint32_t seed() const { return seedValue; }             // random by default, see constructor
+
+        void saveState(State& out) const;                       // snapshot for run-ahead / rollback
+        void loadState(const State& in);                        // restore a snapshot
+        void setSpeculative(bool on) { speculative = on; }      // while on: no beeper changes, no tracing (frames that will be rolled back)
 
         // public state consumed by main.cpp
         std::array<uint8_t, 64 * 32> gfx;           // Display buffer of 2048 pixels (0=off, 1=on)
@@ -26,10 +67,17 @@ class Chip8 {
 
         std::array<uint8_t, 16> V;          // V0-VF, 8 bit general purpose registers (Vx where x ranges from 0 to F (V0-VF))
         std::array<uint16_t, 16> stack;     // call stack of 16 return addresses
-        std::array<uint8_t, 4096> memory;   // Memory (size = 4k)
+        PagedMemory memory;                 // Memory (size = 4k), copy-on-write pages over a shared image
 
         uint8_t delay_timer = 0;            // Delay timer (decrement at 60 Hz)
         uint8_t sound_timer = 0;            // Sound timer (decrement at 60 Hz)
+        Trap trap = Trap::None;             // set instead of over/under-running the stack; cleared by init()
+        uint32_t rng = 1;                   // xorshift32 state for CXNN, part of State so rollback replays the same numbers
+        uint32_t seedValue = 0;             // what rng is reset to by init()
+        uint8_t nextRandom();
+
+        TraceRecorder* tracer = nullptr;    // optional execution trace, not owned
+        bool speculative = false;           // running frames that will be thrown away (see setSpeculative)
 
         Audio audio;
         bool isBeeping = false;
@@ -0,0 +1,285 @@
+#include "display.h"
+#include <SDL_opengl.h>
+#include <algorithm> // for std::min()
+#include <cstring>   // for std::memcpy(), std::strncmp(), std::strstr()
+#include <iostream>  // for std::cerr
+
+Display::~Display()
+{
+    Shutdown();
+}
+
+bool Display::Initialize(const char* title, int w, int h, int s, bool forceSoftware)
+{
+    width = w;
+    height = h;
+    scale = s;
+
+    window = SDL_CreateWindow(
+        title,
+        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        width * scale, height * scale,
+        SDL_WINDOW_SHOWN
+    );
+    if (!window)
+    {
+        std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+
+    // 1) GPU renderer, unless told not to
+    if (!forceSoftware && CreateRenderer(SDL_RENDERER_ACCELERATED, true))
+    {
+        return true;
+    }
+
+    // 2) Software path: scale into the window surface ourselves
+    software = true;
+    if (PrepareSurface())
+    {
+        return true;
+    }
+
+    // 3) Last resort: SDL's software renderer
+    software = false;
+    if (CreateRenderer(SDL_RENDERER_SOFTWARE, false))
+    {
+        return true;
+    }
+    std::cerr << "No usable renderer or window surface: " << SDL_GetError() << "\n";
+    Shutdown();
+    return false;
+}
+
+bool Display::CreateRenderer(Uint32 flags, bool rejectSoftware)
+{
+    renderer = SDL_CreateRenderer(window, -1, flags);
+    if (!renderer)
+    { // no GPU (or no driver for it): fall back quietly
+        return false;
+    }
+
+    if (rejectSoftware && RendersOnCpu())
+    { // "accelerated" but really the CPU: our integer scaler is much faster than its generic GL path
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+        return false;
+    }
+
+    // streaming texture at the logical size; SDL scales it to the window
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!texture)
+    {
+        std::cerr << "SDL_CreateTexture Error: " << SDL_GetError() << "\n";
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool Display::RendersOnCpu() const
+{
+    SDL_RendererInfo info{};
+    if (SDL_GetRendererInfo(renderer, &info) != 0 || !info.name)
+    {
+        return false;
+    }
+    if (info.flags & SDL_RENDERER_SOFTWARE)
+    {
+        return true;
+    }
+
+    // Mesa's CPU rasterisers sit behind the "opengl"/"opengles2" renderers and report themselves as accelerated.
+    // Only the GL_RENDERER string gives them away; the renderer's GL context is current right after creation.
+    if (std::strncmp(info.name, "opengl", 6) != 0)
+    {
+        return false;
+    }
+    using GetStringFn = const GLubyte* (APIENTRY*)(GLenum);
+    auto glGetString = reinterpret_cast<GetStringFn>(SDL_GL_GetProcAddress("glGetString"));
+    if (!glGetString)
+    {
+        return false;
+    }
+    const char* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    if (!glRenderer)
+    {
+        return false;
+    }
+    for (const char* cpu : {"llvmpipe", "softpipe", "swrast", "Software Rasterizer"})
+    {
+        if (std::strstr(glRenderer, cpu))
+        {
+            std::cerr << "GL renderer is " << glRenderer << " (no GPU), using the software display path\n";
+            return true;
+        }
+    }
+    return false;
+}
+
+// Store an SDL_MapRGB value the way a pixel of `bytes` bytes sits in surface memory
+static void storePixel(uint8_t* out, Uint32 value, int bytes)
+{
+    switch (bytes)
+    {
+        case 1:
+            out[0] = static_cast<uint8_t>(value);
+            break;
+        case 2: {
+            Uint16 v16 = static_cast<Uint16>(value);
+            std::memcpy(out, &v16, 2);
+            break;
+        }
+        case 3: // 24-bit: SDL's byte order depends on the host
+            if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+            {
+                out[0] = value & 0xFF; out[1] = (value >> 8) & 0xFF; out[2] = (value >> 16) & 0xFF;
+            }
+            else
+            {
+                out[0] = (value >> 16) & 0xFF; out[1] = (value >> 8) & 0xFF; out[2] = value & 0xFF;
+            }
+            break;
+        default:
+            std::memcpy(out, &value, 4);
+            break;
+    }
+}
+
+bool Display::PrepareSurface()
+{
+    SDL_Surface* surface = SDL_GetWindowSurface(window);
+    if (!surface)
+    {
+        return false;
+    }
+
+    // colours in whatever format the window uses (16-bit on many VNC / remote X setups)
+    pixelBytes = surface->format->BytesPerPixel;
+    storePixel(onPixel, SDL_MapRGB(surface->format, 0xFF, 0xFF, 0xFF), pixelBytes);
+    storePixel(offPixel, SDL_MapRGB(surface->format, 0x00, 0x00, 0x00), pixelBytes);
+    scaledRow.resize(static_cast<std::size_t>(width) * scale * pixelBytes);
+    return true;
+}
+
+bool Display::HandleEvent(const SDL_Event& event)
+{
+    if (event.type != SDL_WINDOWEVENT || event.window.event != SDL_WINDOWEVENT_SIZE_CHANGED)
+    {
+        return false;
+    }
+    // the old window surface is gone: pick up the new one (size and possibly format)
+    if (software && !PrepareSurface())
+    {
+        std::cerr << "SDL_GetWindowSurface Error: " << SDL_GetError() << "\n";
+    }
+    return true;
+}
+
+void Display::Present(const uint8_t* framebuffer)
+{
+    if (software)
+    {
+        PresentSurface(framebuffer);
+    }
+    else
+    {
+        PresentTexture(framebuffer);
+    }
+}
+
+void Display::PresentTexture(const uint8_t* framebuffer)
+{
+    // copy monochrome framebuffer into RGBA pixels
+    uint32_t* pixels;
+    int pitch;
+    SDL_LockTexture(texture, nullptr, (void**)&pixels, &pitch);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            // look up your emulator mon framebuffer:
+            bool on = framebuffer[y * width + x];
+            // calculate the index into pixels[]
+            int rowStart = y * (pitch / 4);     // y * 64: each row is 64 pixels (256 bytes/4 bytes per pixel)
+            int idx = rowStart + x;             // column x in that row
+            pixels[idx] = on ? kOnRGBA : kOffRGBA; // white if on, black if off
+        }
+    }
+    SDL_UnlockTexture(texture);
+
+    // draw the texture to the window (it will be auto-scaled)
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    SDL_RenderPresent(renderer);
+}
+
+void Display::PresentSurface(const uint8_t* framebuffer)
+{
+    SDL_Surface* surface = SDL_GetWindowSurface(window);    // re-fetched each time: resizes replace it
+    if (!surface)
+    {
+        return;
+    }
+    if (surface->format->BytesPerPixel != pixelBytes)
+    {
+        PrepareSurface();
+    }
+
+    // the window manager may have made the window smaller than width*scale x height*scale: only write what fits
+    const std::size_t rowBytes = std::min(scaledRow.size(), static_cast<std::size_t>(surface->w) * pixelBytes);
+    const int outRows = std::min(height * scale, surface->h);
+
+    if (SDL_MUSTLOCK(surface))
+    {
+        SDL_LockSurface(surface);
+    }
+
+    auto* dst = static_cast<uint8_t*>(surface->pixels);
+    int row = 0;
+    for (int y = 0; y < height && row < outRows; ++y)
+    {
+        // expand one logical row to window width once...
+        const uint8_t* src = framebuffer + y * width;
+        uint8_t* out = scaledRow.data();
+        for (int x = 0; x < width; ++x)
+        {
+            const uint8_t* colour = src[x] ? onPixel : offPixel;
+            for (int i = 0; i < scale; ++i)
+            {
+                std::memcpy(out, colour, pixelBytes);
+                out += pixelBytes;
+            }
+        }
+        // ...then copy it to all `scale` window rows it covers
+        for (int i = 0; i < scale && row < outRows; ++i, ++row)
+        {
+            std::memcpy(dst, scaledRow.data(), rowBytes);
+            dst += surface->pitch;
+        }
+    }
+
+    if (SDL_MUSTLOCK(surface))
+    {
+        SDL_UnlockSurface(surface);
+    }
+    SDL_UpdateWindowSurface(window);
+}
+
+void Display::Shutdown()
+{
+    if (texture)
+    {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    if (renderer)
+    {
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+    }
+    if (window)
+    {
+        SDL_DestroyWindow(window);
+        window = nullptr;
+    }
+}
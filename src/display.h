@@ -0,0 +1,50 @@
+#ifndef CHIP8_DISPLAY_H
+#define CHIP8_DISPLAY_H
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+
+// Shows a monochrome framebuffer (one byte per pixel, 0=off, 1=on) in a window, scaled up by an integer factor.
+// Two ways to get pixels on screen:
+//   - renderer: upload to a small streaming texture and let the GPU scale it (the normal path)
+//   - software: write the scaled pixels straight into the window surface (GPU-less hosts, VMs, remote X)
+// The software path is used when asked for, when no accelerated renderer can be created,
+// or when the "accelerated" renderer is really the CPU (GL on Mesa llvmpipe/softpipe/swrast, checked via GL_RENDERER).
+// It writes any surface depth (8/16/24/32-bit) and only as much as fits if the window ended up smaller than asked.
+// If even the window surface is unusable, SDL's software renderer is the last resort.
+class Display {
+public:
+    ~Display();                             // Calls Shutdown()
+
+    bool Initialize(const char* title, int width, int height, int scale, bool forceSoftware);  // width x height logical pixels
+    void Present(const uint8_t* framebuffer);   // framebuffer = width * height bytes, row by row
+    bool HandleEvent(const SDL_Event& event);   // true if the window changed and the frame must be presented again
+    void Shutdown();                        // Destroy texture, renderer and window (safe to call twice)
+    bool IsSoftware() const { return software; }
+
+private:
+    static constexpr uint32_t kOnRGBA = 0xFFFFFFFF;     // white (texture format RGBA8888)
+    static constexpr uint32_t kOffRGBA = 0xFF000000;    // black
+
+    int width = 0;
+    int height = 0;
+    int scale = 1;
+    bool software = false;
+
+    SDL_Window* window = nullptr;
+    SDL_Renderer* renderer = nullptr;       // renderer path only
+    SDL_Texture* texture = nullptr;         // renderer path only
+    int pixelBytes = 0;                     // software path: bytes per surface pixel (1-4)
+    uint8_t onPixel[4] = {};                // software path: white / black in the surface's format, as stored in memory
+    uint8_t offPixel[4] = {};
+    std::vector<uint8_t> scaledRow;         // software path: one logical row expanded to window width
+
+    bool CreateRenderer(Uint32 flags, bool rejectSoftware);  // false = try the next path
+    bool RendersOnCpu() const;              // renderer is SDL's software one or GL on a CPU rasteriser
+    bool PrepareSurface();                  // (re)read the window surface format; false if there is no surface
+    void PresentTexture(const uint8_t* framebuffer);
+    void PresentSurface(const uint8_t* framebuffer);
+};
+
+#endif  // CHIP8_DISPLAY_H
@@ -0,0 +1,4 @@
+#pragma once
+#include <SDL.h>
+
+int mapSDLKeyToChip8(SDL_Keycode key);  // host key -> CHIP-8 keypad index (0x0-0xF), -1 if unmapped
@@ -1,55 +1,104 @@
 #define SDL_MAIN_HANDLED
 #include <SDL.h>
 #include "chip8.h"
+#include "display.h"
+#include "input.h"
+#include "trace.h"
+#include "wall.h"
+#include <cstdlib>   // for std::atoi(), std::strtoul()
 #include <iostream>
+#include <string>
+#include <vector>
 
 // logical chip 8 screen size (resolution)
 constexpr int SCREEN_W = 64;
 constexpr int SCREEN_H = 32;
 // how much to scale each CHIP-8 pixel on your desktop
 constexpr int SCALE = 10;
-
-// helper to map host keys -> CHIP-8 keypad (0x0-0xf)
-int mapSDLKeyToChip8(SDL_Keycode key) {
-    switch (key) {
-        case SDLK_1: return 0x1;
-        case SDLK_2: return 0x2;
-        case SDLK_3: return 0x3;
-        case SDLK_4: return 0xC;
-
-        case SDLK_q: return 0x4;
-        case SDLK_w: return 0x5;
-        case SDLK_e: return 0x6;
-        case SDLK_r: return 0xD;
-
-        case SDLK_a: return 0x7;
-        case SDLK_s: return 0x8;
-        case SDLK_d: return 0x9;
-        case SDLK_f: return 0xE;
-
-        case SDLK_z: return 0xA;
-        case SDLK_x: return 0x0;
-        case SDLK_c: return 0xB;
-        case SDLK_v: return 0xF;
-
-        default: return -1;
-    }
-}
+// audio-sync mode: how much sound to keep queued ahead of playback
+constexpr int AUDIO_TARGET_MS = 50;
 
 int main(int argc, char** argv) {
-    // 1) Handle command-line: must be a filename to load 
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " path/to/game.ch8\n";
+    // 1) Handle command-line: a filename to load, plus options
+    std::vector<std::string> roms;      // one ROM, or any number with --wall
+    int wallCount = 0;                  // machines in the monitoring wall (0 = normal single game)
+    const char* tracePath = nullptr;
+    const char* seedArg = nullptr;      // fixed CXNN seed (reproducible runs / traces)
+    int runAhead = 0;                   // frames to run ahead of the real machine (0 = off)
+    bool audioSync = false;             // pace frames on the audio device instead of SDL_GetTicks
+    bool forceSoftware = false;         // skip the GPU renderer, draw into the window surface
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seedArg = argv[++i];
+        }
+        else if (arg == "--run-ahead" && i + 1 < argc) {
+            runAhead = std::atoi(argv[++i]);
+            if (runAhead < 0 || runAhead > 4) {
+                std::cerr << "--run-ahead takes 0 to 4 frames\n";
+                return 1;
+            }
+        }
+        else if (arg == "--audio-sync") {
+            audioSync = true;
+        }
+        else if (arg == "--software") {
+            forceSoftware = true;
+        }
+        else if (arg == "--wall" && i + 1 < argc) {
+            wallCount = std::atoi(argv[++i]);
+            if (wallCount < 1 || wallCount > WALL_MAX) {
+                std::cerr << "--wall takes 1 to " << WALL_MAX << " machines\n";
+                return 1;
+            }
+        }
+        else if (arg.rfind("--", 0) != 0) {
+            roms.push_back(arg);
+        }
+        else {
+            roms.clear();  // unknown option: fall through to usage
+            break;
+        }
+    }
+    if (roms.empty() || (roms.size() > 1 && wallCount == 0)) {
+        std::cerr << "Usage: " << argv[0] << " [--trace out.c8t] [--seed N] [--run-ahead frames] [--audio-sync] [--software] path/to/game.ch8\n"
+                  << "       " << argv[0] << " --wall N [--software] game.ch8 [more.ch8 ...]\n";
         return 1;
     }
 
+    // 1.5) Monitoring wall: N machines tiled in one window (see wall.cpp)
+    if (wallCount > 0) {
+        if (tracePath || seedArg || runAhead > 0 || audioSync) {
+            std::cerr << "--wall can't be combined with --trace, --seed, --run-ahead or --audio-sync\n";
+            return 1;
+        }
+        return runWall(roms, wallCount, forceSoftware);
+    }
+    const std::string& romPath = roms[0];
+
     // 2) Initialize CHIP-8 core, load the game into CHIP-8 memory
     Chip8 chip8;
     chip8.init();                         // clear memory, regs, load fontset
-    if (!chip8.loadApplication(argv[1])) {      // read file into memory[0x200...]
+    if (!chip8.loadApplication(romPath)) {      // read file into memory[0x200...]
         std::cerr << "Failed to load game\n";
         return 1;
     }
+    if (seedArg) {
+        chip8.setSeed(static_cast<uint32_t>(std::strtoul(seedArg, nullptr, 0)));
+    }
+
+    // 2.5) Optional execution trace (compare two with tools/tracediff)
+    TraceRecorder tracer;
+    if (tracePath) {
+        if (!tracer.open(tracePath, chip8.seed())) {
+            std::cerr << "Failed to open trace file " << tracePath << "\n";
+            return 1;
+        }
+        chip8.setTracer(&tracer);
+    }
 
     // 3) Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
@@ -58,51 +107,24 @@ int main(int argc, char** argv) {
     }
 
     // 3.5) Initialize audio system
-    if (!chip8.initAudio()) {
+    if (!chip8.initAudio(audioSync)) {
         std::cerr << "Failed to initialize audio\n";
         SDL_Quit();
         return 1;
     }
 
-    // 4) Create window (640×320 window, scaled 10×)
-    SDL_Window* window = SDL_CreateWindow(
-        "CHIP-8 Emulator",
-        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        SCREEN_W * SCALE, SCREEN_H * SCALE,
-        SDL_WINDOW_SHOWN
-    );
-    if (!window) {
-        std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << "\n";
-        SDL_Quit();
-        return 1;
-    }
-
-
-    // 5) Create renderer
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (!renderer) {
-        std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << "\n";
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
-    }
-
-    // 6) Create a streaming texture of size 64x32
-    SDL_Texture* texture = SDL_CreateTexture(
-        renderer,
-        SDL_PIXELFORMAT_RGBA8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        SCREEN_W, SCREEN_H
-    );
-    if (!texture) {
-        std::cerr << "SDL_CreateTexture Error: " << SDL_GetError() << "\n";
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
+    // 4) Create window (640×320 window, scaled 10×) + 5) renderer + 6) 64x32 streaming texture
+    //    (or the software surface path when there is no GPU, see display.h)
+    Display display;
+    if (!display.Initialize("CHIP-8 Emulator", SCREEN_W, SCREEN_H, SCALE, forceSoftware)) {
         SDL_Quit();
         return 1;
     }
 
     // 7) Main emulation loop
+    Chip8::State snapshot;              // rollback point for run-ahead, reused every frame
+    bool shownSpeculative = false;      // run-ahead: the window shows frames that will be rolled back
+    double audioDeadline = 0.0;         // audio-sync: consumed-sample count at which the current frame ends
     bool quit = false;
     SDL_Event event;
     while(!quit) {
@@ -113,6 +135,9 @@ int main(int argc, char** argv) {
             if (event.type == SDL_QUIT) {
                 quit = true;
             }
+            else if (display.HandleEvent(event)) {    // window resized: redraw into the new surface
+                chip8.drawFlag = true;
+            }
             else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {    // handle key presses and releases
                 int key = mapSDLKeyToChip8(event.key.keysym.sym);
                 if (key >= 0) {
@@ -129,30 +154,38 @@ int main(int argc, char** argv) {
         for (int i = 0; i < 10; ++i) {
             chip8.emulateCycle();
         }
+        if (chip8.trapped()) {
+            std::cerr << "ROM stopped: " << chip8.trapReason() << "\n";
+            quit = true;
+        }
 
         // 7c) If a draw was requested, update the texture & renderer
-        if (chip8.drawFlag) {
-            // copy 64x32 monochrome framebuffer into RGBA pixels
-            uint32_t* pixels;
-            int pitch;
-            SDL_LockTexture(texture, nullptr, (void**)&pixels, &pitch);
-            for (int y = 0; y < SCREEN_H; ++y) {
-                for (int x = 0; x < SCREEN_W; ++x) {
-                    // look up your emulator mon framebuffer:
-                    bool on = chip8.gfx[y * SCREEN_W + x];
-                    // calculate the index into pixels[]
-                    int rowStart = y * (pitch / 4);     // y * 64: each row is 64 pixels (256 bytes/4 bytes per pixel)
-                    int idx = rowStart + x;             // column x in that row
-                    pixels[idx] = on ? 0xFFFFFFFF : 0xFF000000; // white if on, black if off
+        if (runAhead > 0) {
+            // Run-ahead: run the next frames with the keys held right now, show that result, then roll back.
+            // The picture is runAhead frames ahead of the real machine, hiding that many frames of input lag.
+            bool draw = chip8.drawFlag;
+            chip8.saveState(snapshot);
+            chip8.drawFlag = false;             // so we can tell whether the speculative frames drew
+            chip8.setSpeculative(true);
+            for (int f = 0; f < runAhead; ++f) {
+                chip8.updateTimers();
+                for (int i = 0; i < 10; ++i) {
+                    chip8.emulateCycle();
                 }
             }
-            SDL_UnlockTexture(texture);
-
-            // draw the texture to the window (it will be auto-scaled)
-            SDL_RenderClear(renderer);
-            SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-            SDL_RenderPresent(renderer);
-            
+            bool speculativeDraw = chip8.drawFlag;
+            // also present when the picture on screen came from speculative draws: that future may not have
+            // happened (key released), and the game may not draw again for a long time to correct it
+            if (draw || speculativeDraw || shownSpeculative) {
+                display.Present(chip8.gfx.data());
+                shownSpeculative = speculativeDraw;
+            }
+            chip8.loadState(snapshot);
+            chip8.setSpeculative(false);
+            chip8.drawFlag = false; // reset for next frame
+        }
+        else if (chip8.drawFlag) {
+            display.Present(chip8.gfx.data());
             chip8.drawFlag = false; // reset for next frame
         }
 
@@ -160,16 +193,38 @@ int main(int argc, char** argv) {
         chip8.updateTimers();
 
         // 7e) Cap speed to ~60 Hz
-        Uint32 frameTime = SDL_GetTicks() - frameStart; // How long the cycle took in ms.
-        if (frameTime < 16) { // 16ms = 1/60th of a second
-            SDL_Delay(16 - frameTime); // Delay the remaining time
-        }  
+        if (audioSync) {
+            // The sound card is the clock: a frame ends once the device has played one more nominal frame (rate/60 samples).
+            // The deadline is counted in samples and accumulates, so a late wake-up shortens the next wait instead of drifting.
+            // queueAudioFrame() measures the queue before we block and makes this frame's sound up to 0.5% longer or shorter
+            // to hold the queue at AUDIO_TARGET_MS.
+            chip8.queueAudioFrame(AUDIO_TARGET_MS);
+            double frameSamples = chip8.audioFrameSamples();
+            audioDeadline += frameSamples;
+            double consumed = static_cast<double>(chip8.consumedAudioSamples());
+            if (consumed > audioDeadline + frameSamples) {
+                audioDeadline = consumed;   // fell behind (slow host, stall): resync instead of running frames back to back
+            }
+            while (consumed < audioDeadline && chip8.queuedAudioSamples() > 0) {
+                // sleep most of the remaining time, then re-check the sample count
+                Uint32 ms = static_cast<Uint32>((audioDeadline - consumed) * 1000.0 / (frameSamples * 60.0));
+                SDL_Delay(ms > 1 ? ms - 1 : 1);
+                consumed = static_cast<double>(chip8.consumedAudioSamples());
+            }
+        }
+        else {
+            Uint32 frameTime = SDL_GetTicks() - frameStart; // How long the cycle took in ms.
+            if (frameTime < 16) { // 16ms = 1/60th of a second
+                SDL_Delay(16 - frameTime); // Delay the remaining time
+            }
+        }
     }
 
     // 8) Clean up SDL resources : texture, renderer, then window
-    SDL_DestroyTexture(texture);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    display.Shutdown();
+    if (tracePath && !tracer.close()) {
+        std::cerr << "Trace " << tracePath << " is incomplete: writing it failed (disk full?)\n";
+    }
     SDL_Quit();
     return 0;
 }
@@ -194,6 +249,7 @@ int main(int argc, char** argv) {
         
  5. Renderer:
         SDL_CreateRenderer gives us a hardware‑accelerated 2D renderer.
+        With no GPU (or --software) Display skips 5 and 6 and writes the 10× scaled pixels straight into the window surface instead.
 
  6. Streaming texture:
         We allocate an off-screen 64×32 RGBA texture. On each draw-frame we'll memcpy our mono-pixel data into this and let SDL scale it for us.
@@ -0,0 +1,30 @@
+#include "pagedmemory.h"
+#include <utility>   // for std::move()
+
+void PagedMemory::attach(std::shared_ptr<const Image> shared) {
+    image = std::move(shared);
+    for (std::size_t p = 0; p < kPageCount; ++p) {
+        pages[p] = image->data() + p * kPageSize;
+        owned[p].reset();
+    }
+}
+
+void PagedMemory::makePrivate(std::size_t page) {
+    // copy whatever the page currently reads from (shared image, or a private page shared with a copy of this memory)
+    auto copy = std::make_shared<Page>();
+    for (std::size_t i = 0; i < kPageSize; ++i) {
+        (*copy)[i] = pages[page][i];
+    }
+    owned[page] = std::move(copy);
+    pages[page] = owned[page]->data();
+}
+
+std::size_t PagedMemory::privatePages() const {
+    std::size_t count = 0;
+    for (const auto& page : owned) {
+        if (page) {
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 4 KB CHIP-8 address space stored as 16 pages of 256 bytes.
+// Every page starts out pointing into a shared, read-only image (fontset + ROM), so many
+// machines running the same ROM share one copy. A page only gets a private copy the first
+// time something writes to it (copy-on-write), which in practice is FX33/FX55 scratch space.
+// Addresses are masked to 12 bits, so a ROM that indexes past 0xFFF wraps around instead of touching other memory.
+class PagedMemory {
+    public:
+        static constexpr std::size_t kSize = 4096;                      // Total address space (4k)
+        static constexpr std::size_t kPageBits = 8;                     // 256-byte pages
+        static constexpr std::size_t kPageSize = std::size_t{1} << kPageBits;
+        static constexpr std::size_t kPageCount = kSize / kPageSize;    // 16 pages
+        static constexpr uint16_t kAddrMask = kSize - 1;                // 0xFFF
+
+        using Image = std::array<uint8_t, kSize>;       // full immutable memory image
+        using Page = std::array<uint8_t, kPageSize>;    // one private (written) page
+
+        void attach(std::shared_ptr<const Image> shared);   // point every page at a shared image, drop private pages
+
+        uint8_t read(uint16_t addr) const {
+            addr &= kAddrMask;
+            return pages[addr >> kPageBits][addr & (kPageSize - 1)];
+        }
+
+        void write(uint16_t addr, uint8_t value) {
+            addr &= kAddrMask;
+            std::size_t page = addr >> kPageBits;
+            // only the first write to a page (or a write to a page still shared with a copy) takes the slow path
+            if (!owned[page] || owned[page].use_count() > 1) {
+                makePrivate(page);
+            }
+            (*owned[page])[addr & (kPageSize - 1)] = value;
+        }
+
+        std::size_t privatePages() const;               // number of pages that have been copied so far
+
+    private:
+        std::shared_ptr<const Image> image;                     // shared fontset + ROM image
+        std::array<const uint8_t*, kPageCount> pages{};         // where each page is read from (image or private copy)
+        std::array<std::shared_ptr<Page>, kPageCount> owned;    // private copies, null while the page is untouched
+
+        void makePrivate(std::size_t page);
+};
@@ -0,0 +1,221 @@
+#include "trace.h"
+#include <chrono>    // for std::chrono::milliseconds
+#include <cstring>   // for std::memcmp()
+
+/*
+ Trace file format:
+    header: "C8TR" + 1 version byte + 4 bytes RNG seed (big-endian)
+    then one encoded record per cycle, each relative to the previous record (which starts zeroed):
+        flags byte:
+            bit 0  pc is not previous pc + 2    -> 2 bytes pc follow
+            bit 1  I changed                    -> 2 bytes I follow
+            bit 2  delay timer changed          -> 1 byte follows
+            bit 3  sound timer changed          -> 1 byte follows
+            bit 4  some V register changed      -> 2 bytes mask (bit n = Vn), then one byte per changed register
+        2 bytes opcode (always present)
+    All 16-bit values are big-endian like CHIP-8 itself. A typical record is 3-5 bytes instead of 24.
+*/
+
+static constexpr char kMagic[4] = {'C', '8', 'T', 'R'};
+static constexpr uint8_t kVersion = 2;
+
+enum : uint8_t {
+    kPcJump  = 1 << 0,
+    kIChange = 1 << 1,
+    kDelay   = 1 << 2,
+    kSound   = 1 << 3,
+    kRegs    = 1 << 4,
+};
+
+static void put16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(v >> 8);
+    out.push_back(v & 0xFF);
+}
+
+static void encode(std::vector<uint8_t>& out, const TraceRecord& prev, const TraceRecord& rec) {
+    uint16_t regMask = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (rec.V[i] != prev.V[i]) {
+            regMask |= 1 << i;
+        }
+    }
+
+    uint8_t flags = 0;
+    if (rec.pc != static_cast<uint16_t>(prev.pc + 2)) flags |= kPcJump;
+    if (rec.I != prev.I)                              flags |= kIChange;
+    if (rec.delay_timer != prev.delay_timer)          flags |= kDelay;
+    if (rec.sound_timer != prev.sound_timer)          flags |= kSound;
+    if (regMask)                                      flags |= kRegs;
+
+    out.push_back(flags);
+    if (flags & kPcJump) put16(out, rec.pc);
+    if (flags & kIChange) put16(out, rec.I);
+    if (flags & kDelay) out.push_back(rec.delay_timer);
+    if (flags & kSound) out.push_back(rec.sound_timer);
+    if (flags & kRegs) {
+        put16(out, regMask);
+        for (int i = 0; i < 16; ++i) {
+            if (regMask & (1 << i)) {
+                out.push_back(rec.V[i]);
+            }
+        }
+    }
+    put16(out, rec.opcode);
+}
+
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::open(const std::string& filepath, uint32_t seed) {
+    close();
+    file.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(kMagic, sizeof(kMagic));
+    file.put(static_cast<char>(kVersion));
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        file.put(static_cast<char>((seed >> shift) & 0xFF));
+    }
+
+    ring.resize(kCapacity);     // ~1.5 MB, only when tracing is actually on
+    head.store(0);
+    tail.store(0);
+    running = true;
+    writer = std::thread(&TraceRecorder::drain, this);
+    return true;
+}
+
+bool TraceRecorder::close() {
+    if (writer.joinable()) {
+        running = false;        // writer empties the ring before it exits
+        writer.join();
+    }
+    if (file.is_open()) {
+        file.close();
+        if (file.fail()) {
+            writeFailed = true;
+        }
+    }
+    return !writeFailed;
+}
+
+void TraceRecorder::drain() {
+    TraceRecord prev;
+    std::vector<uint8_t> out;
+    out.reserve(64 * 1024);
+
+    while (true) {
+        // read running before head so nothing recorded before close() is missed
+        bool stopping = !running.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+
+        if (t == h) {
+            if (stopping) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        for (; t != h; ++t) {
+            const TraceRecord& rec = ring[t & (kCapacity - 1)];
+            encode(out, prev, rec);
+            prev = rec;
+            // hand slots back in batches so the emulator isn't stalled behind the file write
+            if (out.size() >= 60 * 1024) {
+                tail.store(t + 1, std::memory_order_release);
+                writeOut(out);
+            }
+        }
+        tail.store(t, std::memory_order_release);
+        writeOut(out);
+    }
+    file.flush();
+    if (file.fail()) {
+        writeFailed = true;
+    }
+}
+
+void TraceRecorder::writeOut(std::vector<uint8_t>& out) {
+    // after a failed write (disk full...) keep draining so the emulator never blocks, but stop writing:
+    // the file is already incomplete and close() will say so
+    if (!writeFailed) {
+        file.write(reinterpret_cast<const char*>(out.data()), out.size());
+        if (file.fail()) {
+            writeFailed = true;
+        }
+    }
+    out.clear();
+}
+
+
+bool TraceReader::open(const std::string& filepath) {
+    file.open(filepath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    char header[sizeof(kMagic) + 1 + 4];
+    file.read(header, sizeof(header));
+    if (file.fail() || std::memcmp(header, kMagic, sizeof(kMagic)) != 0 || static_cast<uint8_t>(header[4]) != kVersion) {
+        return false;
+    }
+    seedValue = 0;
+    for (int i = 5; i < 9; ++i) {
+        seedValue = (seedValue << 8) | static_cast<uint8_t>(header[i]);
+    }
+    prev = TraceRecord{};
+    partial = false;
+    return true;
+}
+
+bool TraceReader::next(TraceRecord& rec) {
+    auto get8 = [this](uint8_t& v) {
+        int c = file.get();
+        v = static_cast<uint8_t>(c);
+        return c != std::char_traits<char>::eof();
+    };
+    auto get16 = [&](uint16_t& v) {
+        uint8_t hi, lo;
+        if (!get8(hi) || !get8(lo)) {
+            return false;
+        }
+        v = (hi << 8) | lo;
+        return true;
+    };
+
+    uint8_t flags;
+    if (!get8(flags)) {
+        return false;   // clean end of file: nothing of a next record was written
+    }
+
+    // from here on, running out of bytes means the record was cut short
+    partial = true;
+    rec = prev;
+    rec.pc = prev.pc + 2;
+    if ((flags & kPcJump) && !get16(rec.pc)) return false;
+    if ((flags & kIChange) && !get16(rec.I)) return false;
+    if ((flags & kDelay) && !get8(rec.delay_timer)) return false;
+    if ((flags & kSound) && !get8(rec.sound_timer)) return false;
+    if (flags & kRegs) {
+        uint16_t regMask;
+        if (!get16(regMask)) {
+            return false;
+        }
+        for (int i = 0; i < 16; ++i) {
+            if ((regMask & (1 << i)) && !get8(rec.V[i])) {
+                return false;
+            }
+        }
+    }
+    if (!get16(rec.opcode)) {
+        return false;
+    }
+
+    partial = false;
+    prev = rec;
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// CPU state after one emulateCycle(), as written to / read back from a trace file
+struct TraceRecord {
+    uint16_t pc = 0;                    // address the opcode was fetched from
+    uint16_t opcode = 0;                // opcode that was executed
+    uint16_t I = 0;                     // index register after execution
+    uint8_t delay_timer = 0;
+    uint8_t sound_timer = 0;
+    std::array<uint8_t, 16> V{};        // V0-VF after execution
+};
+
+// Records one TraceRecord per cycle without slowing the emulator down much:
+// record() only copies the state into a lock-free single-producer/single-consumer ring,
+// a background thread drains the ring, delta-encodes each record against the previous one and writes it to disk.
+class TraceRecorder {
+    public:
+        ~TraceRecorder();                               // flushes and closes the file
+
+        bool open(const std::string& filepath, uint32_t seed);  // start the writer thread; seed = the machine's CXNN seed, stored in the header
+        bool close();                                   // drain everything recorded so far, stop the writer thread; false if a write failed (e.g. disk full)
+
+        void record(const TraceRecord& rec) {           // emulator thread only
+            size_t h = head.load(std::memory_order_relaxed);
+            // ring full: wait for the writer to catch up rather than drop cycles
+            while (h - tail.load(std::memory_order_acquire) == kCapacity) {
+                std::this_thread::yield();
+            }
+            ring[h & (kCapacity - 1)] = rec;
+            head.store(h + 1, std::memory_order_release);
+        }
+
+    private:
+        static constexpr size_t kCapacity = size_t{1} << 16;  // records in flight (must be a power of 2)
+
+        std::vector<TraceRecord> ring;                  // allocated by open(), so an unused recorder costs nothing
+        alignas(64) std::atomic<size_t> head{0};        // next slot the emulator writes
+        alignas(64) std::atomic<size_t> tail{0};        // next slot the writer reads
+        std::atomic<bool> running{false};
+        std::atomic<bool> writeFailed{false};           // latched by the writer, reported by close()
+
+        std::ofstream file;
+        std::thread writer;
+        void drain();                                   // writer thread body
+        void writeOut(std::vector<uint8_t>& out);       // write + clear one encoded batch, latching writeFailed
+};
+
+// Reads a trace file back into full records, one at a time
+class TraceReader {
+    public:
+        bool open(const std::string& filepath);
+        bool next(TraceRecord& rec);                    // false at end of file (or on a truncated record, see truncated())
+        bool truncated() const { return partial; }      // the file ended in the middle of a record
+        uint32_t seed() const { return seedValue; }     // CXNN seed the trace was recorded with
+
+    private:
+        std::ifstream file;
+        TraceRecord prev;                               // decoder state: last record returned
+        uint32_t seedValue = 0;
+        bool partial = false;
+};
@@ -0,0 +1,164 @@
+#include "wall.h"
+#include <SDL.h>
+#include <algorithm> // for std::max(), std::min(), std::copy_n()
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <cmath>     // for std::ceil(), std::sqrt()
+#include <iostream>  // for std::cerr
+#include <memory>
+#include <thread>
+#include "chip8.h"
+#include "display.h"
+#include "input.h"
+
+static constexpr int SCREEN_W = 64;
+static constexpr int SCREEN_H = 32;
+static constexpr int WALL_MAX_WIDTH = 1280;    // pick the largest integer scale that keeps the window this wide or less
+
+int runWall(const std::vector<std::string>& roms, int count, bool forceSoftware) {
+    // 1) Load each ROM image once; machines running the same ROM share it (copy-on-write memory)
+    //    Only the first `count` ROMs get a machine, so don't load the rest.
+    const std::size_t used = std::min(roms.size(), static_cast<std::size_t>(count));
+    for (std::size_t i = used; i < roms.size(); ++i) {
+        std::cerr << "Not enough machines for " << roms[i] << ", skipping it\n";
+    }
+    std::vector<std::shared_ptr<const PagedMemory::Image>> images;
+    for (std::size_t i = 0; i < used; ++i) {
+        const std::string& path = roms[i];
+        auto image = Chip8::loadImage(path);
+        if (!image) {
+            std::cerr << "Failed to load game " << path << "\n";
+            return 1;
+        }
+        images.push_back(std::move(image));
+    }
+
+    std::vector<std::unique_ptr<Chip8>> machines;
+    for (int i = 0; i < count; ++i) {
+        machines.push_back(std::make_unique<Chip8>());
+        machines.back()->loadApplication(images[i % images.size()]);
+    }
+
+    // 2) Grid layout: as square as possible, one 64x32 tile per machine in one big framebuffer
+    const int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const int rows = (count + cols - 1) / cols;
+    const int wallW = cols * SCREEN_W;
+    const int wallH = rows * SCREEN_H;
+    const int scale = std::max(1, WALL_MAX_WIDTH / wallW);
+    std::vector<uint8_t> wall(wallW * wallH, 0);
+
+    // 3) Window (one texture for the whole wall)
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init Error: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    Display display;
+    if (!display.Initialize("CHIP-8 Wall", wallW, wallH, scale, forceSoftware)) {
+        SDL_Quit();
+        return 1;
+    }
+
+    // 4) Worker threads: worker w steps machines w, w + workers, w + 2*workers, ...
+    //    Each frame the main thread releases them through frameStart and waits on frameDone,
+    //    so keypads and the wall framebuffer are only touched by one side at a time.
+    const int workers = std::max(1, std::min<int>(count, std::thread::hardware_concurrency()));
+    std::barrier frameStart(workers + 1);
+    std::barrier frameDone(workers + 1);
+    std::atomic<bool> quit{false};
+    std::atomic<bool> dirty{true};
+
+    auto step = [&](int w) {
+        while (true) {
+            frameStart.arrive_and_wait();
+            if (quit) {
+                break;
+            }
+            bool drew = false;
+            for (int m = w; m < count; m += workers) {
+                Chip8& chip8 = *machines[m];
+                for (int i = 0; i < 10; ++i) {
+                    chip8.emulateCycle();
+                }
+                chip8.updateTimers();
+                // copy changed screens into their tile; tiles don't overlap so workers never write the same bytes
+                if (chip8.drawFlag) {
+                    uint8_t* tile = wall.data() + (m / cols) * SCREEN_H * wallW + (m % cols) * SCREEN_W;
+                    for (int y = 0; y < SCREEN_H; ++y) {
+                        std::copy_n(chip8.gfx.data() + y * SCREEN_W, SCREEN_W, tile + y * wallW);
+                    }
+                    chip8.drawFlag = false;
+                    drew = true;
+                }
+            }
+            if (drew) {
+                dirty = true;
+            }
+            frameDone.arrive_and_wait();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back(step, w);
+    }
+
+    // 5) Main loop: input -> step all machines -> one present
+    std::array<uint8_t, 16> keypad{};
+    std::vector<bool> trapReported(count, false);
+    SDL_Event event;
+    bool running = true;
+    while (running) {
+        Uint32 frameStartTicks = SDL_GetTicks();
+
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                running = false;
+            }
+            else if (display.HandleEvent(event)) {
+                dirty = true;
+            }
+            else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+                int key = mapSDLKeyToChip8(event.key.keysym.sym);
+                if (key >= 0) {
+                    keypad[key] = (event.type == SDL_KEYDOWN);
+                }
+                if (event.key.keysym.sym == SDLK_ESCAPE) {
+                    running = false;
+                }
+            }
+        }
+        for (auto& chip8 : machines) {
+            chip8->keypad = keypad;
+        }
+
+        frameStart.arrive_and_wait();
+        frameDone.arrive_and_wait();
+
+        // A trapped machine's tile just freezes, so say which one crashed (once, while the workers are idle)
+        for (int m = 0; m < count; ++m) {
+            if (!trapReported[m] && machines[m]->trapped()) {
+                std::cerr << "Machine " << m << " (" << roms[m % used] << ") stopped: " << machines[m]->trapReason() << "\n";
+                trapReported[m] = true;
+            }
+        }
+
+        if (dirty.exchange(false)) {
+            display.Present(wall.data());
+        }
+
+        Uint32 frameTime = SDL_GetTicks() - frameStartTicks;
+        if (frameTime < 16) {
+            SDL_Delay(16 - frameTime);
+        }
+    }
+
+    // 6) Stop workers, clean up
+    quit = true;
+    frameStart.arrive_and_wait();
+    for (auto& t : threads) {
+        t.join();
+    }
+    display.Shutdown();
+    SDL_Quit();
+    return 0;
+}
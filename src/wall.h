@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+#include <vector>
+
+constexpr int WALL_MAX = 256;   // most machines one wall will run
+
+// Monitoring wall: run `count` machines (ROMs assigned round-robin from `roms`) in parallel worker threads,
+// tiled into one window that is presented with a single texture upload + draw per frame.
+// Keys are sent to every machine. Returns the process exit code.
+int runWall(const std::vector<std::string>& roms, int count, bool forceSoftware);
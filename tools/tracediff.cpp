@@ -0,0 +1,73 @@
+// tracediff: find the first cycle where two execution traces (chip8.elf --trace) disagree.
+// Usage: tracediff a.c8t b.c8t
+// Exit code: 0 = identical, 1 = traces diverge, 2 = could not read a trace (or it is truncated)
+#include <cstdio>
+#include "trace.h"
+
+static void printRecord(const char* label, const TraceRecord& r) {
+    std::printf("  %s pc=%03X op=%04X I=%03X DT=%02X ST=%02X V=", label, r.pc, r.opcode, r.I, r.delay_timer, r.sound_timer);
+    for (int i = 0; i < 16; ++i) {
+        std::printf("%02X%s", r.V[i], i < 15 ? " " : "\n");
+    }
+}
+
+static bool sameRecord(const TraceRecord& a, const TraceRecord& b) {
+    return a.pc == b.pc && a.opcode == b.opcode && a.I == b.I
+        && a.delay_timer == b.delay_timer && a.sound_timer == b.sound_timer && a.V == b.V;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s a.c8t b.c8t\n", argv[0]);
+        return 2;
+    }
+
+    TraceReader a, b;
+    if (!a.open(argv[1])) {
+        std::fprintf(stderr, "Cannot read trace %s\n", argv[1]);
+        return 2;
+    }
+    if (!b.open(argv[2])) {
+        std::fprintf(stderr, "Cannot read trace %s\n", argv[2]);
+        return 2;
+    }
+
+    // different seeds make CXNN differ, so a divergence there says nothing about the engines
+    if (a.seed() != b.seed()) {
+        std::fprintf(stderr, "warning: traces were recorded with different seeds (%u vs %u), rerun both with --seed\n", a.seed(), b.seed());
+    }
+
+    TraceRecord ra, rb;
+    TraceRecord lastSame;
+    unsigned long long cycle = 0;
+    while (true) {
+        bool hasA = a.next(ra);
+        bool hasB = b.next(rb);
+
+        // a record cut short (disk full, recorder killed) is a broken file, not the emulators diverging
+        if ((!hasA && a.truncated()) || (!hasB && b.truncated())) {
+            std::printf("truncated trace: %s ends in the middle of a record after %llu cycles\n",
+                        (!hasA && a.truncated()) ? argv[1] : argv[2], cycle);
+            return 2;
+        }
+        if (!hasA && !hasB) {
+            std::printf("traces identical (%llu cycles)\n", cycle);
+            return 0;
+        }
+        if (hasA != hasB) {
+            std::printf("%s ends first after %llu cycles\n", hasA ? argv[2] : argv[1], cycle);
+            return 1;
+        }
+        if (!sameRecord(ra, rb)) {
+            std::printf("first divergence at cycle %llu\n", cycle);
+            if (cycle > 0) {
+                printRecord("last  ", lastSame);
+            }
+            printRecord("a     ", ra);
+            printRecord("b     ", rb);
+            return 1;
+        }
+        lastSame = ra;
+        ++cycle;
+    }
+}